@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+#include <cstdio>
+#include <exception>
+
+#include "../../main/p0957/proxy.h"
+
+struct Name : std::dispatch<const char*()> {
+  template <class T>
+  const char* operator()(const T& self) { return self.Name(); }
+};
+
+struct FShape : std::facade<Name> {};
+
+class Box {
+ public:
+  const char* Name() const { return "Box"; }
+};
+
+class Ball {
+ public:
+  const char* Name() const { return "Ball"; }
+};
+
+class Wall {
+ public:
+  const char* Name() const { return "Wall"; }
+};
+
+struct Collide : std::dispatch<void(double)> {
+  void operator()(const Box&, const Box&, double speed)
+      { printf("Two boxes collided at %f\n", speed); }
+  void operator()(const Box&, const Ball&, double speed)
+      { printf("A box hit a ball at %f\n", speed); }
+  void operator()(const Ball&, const Box&, double speed)
+      { printf("A ball hit a box at %f\n", speed); }
+  void operator()(const Ball&, const Ball&, double speed)
+      { printf("Two balls bounced at %f\n", speed); }
+};
+
+std::multi_dispatch<Collide, FShape, FShape>& GetCollisionRules() {
+  static std::multi_dispatch<Collide, FShape, FShape> rules = [] {
+    std::multi_dispatch<Collide, FShape, FShape> result;
+    result.register_overload<Box*, Box*>();
+    result.register_overload<Box*, Ball*>();
+    result.register_overload<Ball*, Box*>();
+    result.register_overload<Ball*, Ball*>();
+    return result;
+  }();
+  return rules;
+}
+
+void DoCollide(std::proxy<FShape>& a, std::proxy<FShape>& b, double speed) {
+  try {
+    GetCollisionRules()(a, b, speed);
+  } catch (const std::exception& e) {
+    printf("No rule for %s and %s: %s\n", a.invoke(), b.invoke(), e.what());
+  }
+}
+
+int main() {
+  Box box;
+  Ball ball;
+  Wall wall;
+  std::proxy<FShape> p1 = &box, p2 = &ball, p3 = &wall;
+  DoCollide(p1, p1, 1.);
+  DoCollide(p1, p2, 2.);
+  DoCollide(p2, p1, 3.);
+  DoCollide(p2, p2, 4.);
+  DoCollide(p2, p3, 5.);
+}
@@ -22,7 +22,8 @@ struct Area : std::dispatch<double()> {
   double operator()(const T& self) { return self.Area(); }
 };
 
-struct FDrawable : std::facade<Draw, Area> {};
+// The area is computed once and cached until another dispatch is invoked
+struct FDrawable : std::facade<Draw, std::memoized<Area>> {};
 
 class Rectangle {
  public:
@@ -60,7 +61,7 @@ class Point {
 void DoSomethingWithDrawable(std::proxy<FDrawable> p) {
   printf("The drawable is: ");
   p.invoke<Draw>();
-  printf(", area = %f\n", p.invoke<Area>());
+  printf(", area = %f\n", p.invoke<std::memoized<Area>>());
 }
 
 std::vector<std::string> ParseCommand(const std::string& s) {
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+// This demo requires std::expected (-std=c++2b).
+
+#include <chrono>
+#include <cstdio>
+#include <expected>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../main/p0957/proxy.h"
+
+struct LookupError {
+  explicit LookupError(int key) : key(key) {}
+  explicit LookupError(std::proxy_errc) : key(-1) {}
+
+  int key;
+};
+
+struct At : std::dispatch<std::string(int)> {
+  template <class T>
+  auto operator()(T& self, int key) { return self.at(key); }
+};
+struct Find : std::dispatch<std::expected<std::string, LookupError>(int)> {
+  template <class T>
+  std::expected<std::string, LookupError> operator()(T& self, int key) {
+    auto it = self.find(key);
+    if (it == self.end()) {
+      return std::unexpected<LookupError>(std::in_place, key);
+    }
+    return it->second;
+  }
+};
+
+struct FResourceDictionary : std::facade<At, Find> {};
+
+constexpr int kDictionarySize = 1024;
+constexpr int kLookups = 1000000;
+
+template <class Lookup>
+void Measure(const char* name, const std::vector<int>& keys, Lookup lookup) {
+  std::size_t hits = 0u;
+  auto begin = std::chrono::steady_clock::now();
+  for (int key : keys) {
+    hits += lookup(key);
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - begin);
+  printf("  %-8s %8.1f ns/lookup (%zu hits)\n", name,
+      elapsed.count() / keys.size(), hits);
+}
+
+int main() {
+  std::unordered_map<int, std::string> dictionary;
+  for (int i = 0; i < kDictionarySize; ++i) {
+    dictionary.emplace(i, std::to_string(i));
+  }
+  std::proxy<FResourceDictionary> p = &dictionary;
+
+  for (int miss_percentage : {0, 1, 10, 50, 90}) {
+    std::vector<int> keys(kLookups);
+    for (int i = 0; i < kLookups; ++i) {
+      keys[i] = i * 37 % 100 < miss_percentage
+          ? kDictionarySize + i % kDictionarySize : i % kDictionarySize;
+    }
+    printf("Miss rate %d%%:\n", miss_percentage);
+    Measure("throw", keys, [&](int key) -> bool {
+      try {
+        return !p.invoke<At>(key).empty();
+      } catch (const std::out_of_range&) {
+        return false;
+      }
+    });
+    Measure("expected", keys, [&](int key) -> bool {
+      return p.try_invoke<Find>(key).has_value();
+    });
+  }
+
+  std::proxy<FResourceDictionary> empty;
+  auto result = empty.try_invoke<Find>(1);
+  printf("Lookup on an empty dictionary %s\n",
+      result.has_value() ? "succeeded" : "failed without throwing");
+}
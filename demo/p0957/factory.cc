@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <numbers>
+#include <stdexcept>
+
+#include "../../main/p0957/proxy.h"
+
+struct Draw : std::dispatch<void()> {
+  template <class T>
+  void operator()(const T& self) { self.Draw(); }
+};
+struct Area : std::dispatch<double()> {
+  template <class T>
+  double operator()(const T& self) { return self.Area(); }
+};
+
+struct FDrawable : std::facade<Draw, Area> {};
+
+using Arguments = const std::vector<std::string>&;
+
+class Rectangle {
+ public:
+  explicit Rectangle(Arguments args)
+      : width_(std::stod(args.at(0u))), height_(std::stod(args.at(1u))) {}
+  void Draw() const
+      { printf("{Rectangle: width = %f, height = %f}", width_, height_); }
+  double Area() const { return width_ * height_; }
+
+ private:
+  double width_;
+  double height_;
+};
+
+class Circle {
+ public:
+  explicit Circle(Arguments args) : radius_(std::stod(args.at(0u))) {}
+  void Draw() const { printf("{Circle: radius = %f}", radius_); }
+  double Area() const { return std::numbers::pi * radius_ * radius_; }
+
+ private:
+  double radius_;
+};
+
+class Point {
+ public:
+  explicit Point(Arguments) {}
+  void Draw() const { printf("{Point}"); }
+  constexpr double Area() const { return 0; }
+};
+
+using DrawableEntry = std::proxy_factory_entry<FDrawable, Arguments>;
+
+constexpr std::proxy_factory kDrawableFactory{{
+    DrawableEntry::of<Rectangle, std::proxy_storage::pooled>("Rectangle"),
+    DrawableEntry::of<Circle, std::proxy_storage::inplace>("Circle"),
+    DrawableEntry::of<Point>("Point"),
+}};
+
+std::proxy<FDrawable> MakeDrawable(const std::string& name, Arguments args) {
+  std::proxy<FDrawable> result = kDrawableFactory.create(name, args);
+  if (!result.has_value()) {
+    throw std::runtime_error{"Invalid type name"};
+  }
+  return result;
+}
+
+int main() {
+  std::vector<std::proxy<FDrawable>> drawables;
+  drawables.push_back(MakeDrawable("Rectangle", {"2", "3"}));
+  drawables.push_back(MakeDrawable("Circle", {"1"}));
+  drawables.push_back(MakeDrawable("Point", {}));
+  for (std::proxy<FDrawable>& p : drawables) {
+    printf("The drawable is: ");
+    p.invoke<Draw>();
+    printf(", area = %f\n", p.invoke<Area>());
+  }
+  try {
+    MakeDrawable("Triangle", {"2", "3"});
+  } catch (const std::exception& e) {
+    printf("Caught exception: %s\n", e.what());
+  }
+}
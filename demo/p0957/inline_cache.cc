@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+#include <cstdio>
+#include <numbers>
+#include <vector>
+
+#include "../../main/p0957/proxy.h"
+
+struct Area : std::dispatch<double()> {
+  template <class T>
+  double operator()(const T& self) { return self.Area(); }
+};
+
+struct FShape : std::facade<Area> {};
+
+class Circle {
+ public:
+  explicit Circle(double radius) : radius_(radius) {}
+  double Area() const { return std::numbers::pi * radius_ * radius_; }
+
+ private:
+  double radius_;
+};
+
+class Square {
+ public:
+  explicit Square(double side) : side_(side) {}
+  double Area() const { return side_ * side_; }
+
+ private:
+  double side_;
+};
+
+int main() {
+  std::vector<Circle> circles;
+  for (int i = 1; i <= 99; ++i) {
+    circles.emplace_back(i);
+  }
+  Square square{2.};
+  std::vector<std::proxy<FShape>> shapes;
+  for (Circle& circle : circles) {
+    shapes.emplace_back(&circle);
+  }
+  shapes.emplace_back(&square);  // The only shape that is not a circle
+
+  // Almost every shape is a circle, so the call is devirtualized
+  double total = 0.;
+  for (std::proxy<FShape>& shape : shapes) {
+    total += shape.invoke_expect<Circle*, Area>();
+  }
+  printf("Total area with invoke_expect: %f\n", total);
+
+  // The same speculation, with counters to tell whether it pays off
+  std::inline_cache<Circle*, Area, true> cached_area;
+  total = 0.;
+  for (std::proxy<FShape>& shape : shapes) {
+    total += cached_area(shape);
+  }
+  printf("Total area with inline_cache: %f\n", total);
+  printf("Cache hits: %zu, misses: %zu\n", cached_area.hits(),
+      cached_area.misses());
+}
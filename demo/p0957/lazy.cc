@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../main/p0957/proxy.h"
+
+struct Lookup : std::dispatch<std::string(const std::string&)> {
+  template <class T>
+  std::string operator()(const T& self, const std::string& key)
+      { return self.Lookup(key); }
+};
+
+struct Size : std::dispatch<std::size_t()> {
+  template <class T>
+  std::size_t operator()(const T& self) noexcept { return self.Size(); }
+};
+
+struct FConfig : std::facade<Lookup, Size> {};
+
+class Config {
+ public:
+  explicit Config(std::string path) : path_(std::move(path)) {
+    if (failures_left_ > 0) {
+      --failures_left_;
+      throw std::runtime_error("The disk is busy");
+    }
+    printf("Loaded %s\n", path_.c_str());
+  }
+  std::string Lookup(const std::string& key) const
+      { return path_ + ":" + key; }
+  std::size_t Size() const noexcept { return path_.size(); }
+
+  static inline int failures_left_ = 0;
+
+ private:
+  std::string path_;
+};
+
+int main() {
+  // Unsynchronized: the owner is the only thread that dispatches
+  auto local = std::make_lazy_proxy<FConfig, Config,
+      std::lazy_initialization::unsynchronized>("local.ini");
+  puts("The local config was not loaded yet");
+  Config::failures_left_ = 1;
+  try {
+    // Size is noexcept, but loading the config on first use may still throw
+    local.invoke<Size>();
+  } catch (const std::exception& e) {
+    printf("First load failed: %s\n", e.what());
+  }
+  // The captured path is still intact, so the retry loads the same file
+  printf("%s\n", local.invoke<Lookup>(std::string{"user"}).c_str());
+
+  // Synchronized: several threads race for the first dispatch
+  auto shared = std::make_lazy_proxy<FConfig, Config>("shared.ini");
+  std::vector<std::thread> threads;
+  std::vector<std::string> results(4u);
+  for (std::size_t i = 0u; i < results.size(); ++i) {
+    threads.emplace_back([&shared, &results, i] {
+      results[i] = shared.invoke<Lookup>(std::to_string(i));
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  for (const std::string& result : results) {
+    printf("%s\n", result.c_str());
+  }
+}
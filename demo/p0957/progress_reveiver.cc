@@ -127,9 +127,34 @@ struct DemoContext {
   std::exception_ptr ex_;
 };
 
+// A second receiver that is notified along with the context
+class ProgressLogger {
+ public:
+  explicit ProgressLogger(std::shared_ptr<DemoContext> ctx)
+      : ctx_(std::move(ctx)) {}
+
+  void Initialize(std::size_t total) { printf("[log] %zu jobs\n", total); }
+  void UpdateProgress(std::size_t progress) {
+    if (progress % 100u == 0u) {
+      printf("[log] %zu jobs done\n", progress);
+    }
+  }
+  // The multicast returns the value of the last receiver, so the logger
+  // reports the decision of the context instead of making its own
+  bool IsCanceled() { return ctx_->IsCanceled(); }
+  void OnException(std::exception_ptr) { puts("[log] The job failed"); }
+
+ private:
+  std::shared_ptr<DemoContext> ctx_;
+};
+
 int main() {
   auto ctx = std::make_shared<DemoContext>();
-  std::thread t1{MyLibrary, ctx};
+  auto receivers =
+      std::make_shared<std::proxy_multicast<FProgressReceiver>>();
+  receivers->subscribe(ctx);
+  receivers->subscribe(std::make_shared<ProgressLogger>(ctx));
+  std::thread t1{MyLibrary, receivers};
   std::thread t2([ctx] {
     std::this_thread::sleep_for(std::chrono::milliseconds(5000));
     puts("Canceling the work...");
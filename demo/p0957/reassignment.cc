@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+#include <array>
+#include <cstdio>
+
+#include "../../main/p0957/proxy.h"
+
+struct Describe : std::dispatch<void()> {
+  template <class T>
+  void operator()(const T& self) { self.Describe(); }
+};
+
+struct FDescribable : std::facade<Describe> {
+  static constexpr std::constraint_level minimum_copyability =
+      std::constraint_level::nontrivial;
+};
+
+// Too large for inline storage, so make_proxy puts it on the heap
+class Frame {
+ public:
+  explicit Frame(int id) : id_(id) { printf("Frame %d was allocated\n", id); }
+  Frame(const Frame& rhs) : id_(rhs.id_)
+      { printf("Frame %d was copied into a new allocation\n", id_); }
+  Frame& operator=(const Frame& rhs) {
+    printf("Frame %d was overwritten by frame %d in place\n", id_, rhs.id_);
+    id_ = rhs.id_;
+    return *this;
+  }
+  ~Frame() { printf("Frame %d was freed\n", id_); }
+  void Describe() const { printf("This is frame %d\n", id_); }
+
+ private:
+  int id_;
+  std::array<double, 64> pixels_{};
+};
+
+class Label {
+ public:
+  void Describe() const { puts("This is a label"); }
+};
+
+int main() {
+  auto current = std::make_proxy<FDescribable, Frame>(1);
+  auto next = std::make_proxy<FDescribable, Frame>(2);
+  puts("Assigning a proxy that holds the same type:");
+  current = next;  // Reuses the heap block of frame 1
+  current.invoke<Describe>();
+
+  puts("Assigning a proxy that holds another type:");
+  Label label;
+  std::proxy<FDescribable> other = &label;
+  current = other;  // Frees the frame and rebuilds the proxy
+  current.invoke<Describe>();
+  puts("Done");
+}
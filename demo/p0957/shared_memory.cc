@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+// This demo requires Linux (memfd_create, mmap and fork).
+
+#include <cstdio>
+#include <numbers>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../main/p0957/proxy.h"
+
+struct Draw : std::dispatch<void()> {
+  template <class T>
+  void operator()(const T& self) { self.Draw(); }
+};
+struct Area : std::dispatch<double()> {
+  template <class T>
+  double operator()(const T& self) { return self.Area(); }
+};
+
+struct FDrawable : std::facade<Draw, Area> {};
+
+class Rectangle {
+ public:
+  Rectangle(double width, double height) : width_(width), height_(height) {}
+  void Draw() const
+      { printf("{Rectangle: width = %f, height = %f}", width_, height_); }
+  double Area() const { return width_ * height_; }
+
+ private:
+  double width_;
+  double height_;
+};
+
+class Circle {
+ public:
+  explicit Circle(double radius) : radius_(radius) {}
+  void Draw() const { printf("{Circle: radius = %f}", radius_); }
+  double Area() const { return std::numbers::pi * radius_ * radius_; }
+
+ private:
+  double radius_;
+};
+
+class Polygon {
+ public:
+  explicit Polygon(double side) : sides_{side, side, side, side, side} {}
+  void Draw() const { printf("{Pentagon: side = %f}", sides_[0]); }
+  double Area() const { return 1.720477400588967 * sides_[0] * sides_[0]; }
+
+ private:
+  double sides_[5];
+};
+
+struct Segment {
+  std::shm_proxy<FDrawable> drawables[3];
+  double areas[3];
+};
+
+constexpr std::size_t kSegmentSize = 1u << 16u;
+
+void* MapSegment(int fd) {
+  void* result = mmap(nullptr, kSegmentSize, PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+  if (result == MAP_FAILED) {
+    perror("mmap");
+    _exit(1);
+  }
+  return result;
+}
+
+int main() {
+  int fd = memfd_create("proxy_demo", 0);
+  if (fd < 0 || ftruncate(fd, kSegmentSize) != 0) {
+    perror("memfd_create");
+    return 1;
+  }
+  char* base = static_cast<char*>(MapSegment(fd));
+  auto* arena = new(base) std::shm_arena(kSegmentSize / 2u);
+  auto* segment = new(base + kSegmentSize / 2u) Segment();
+  segment->drawables[0].emplace<Rectangle>(*arena, 2., 3.);
+  segment->drawables[1].emplace<Circle>(*arena, 1.);
+  segment->drawables[2].emplace<Polygon>(*arena, 1.);
+  printf("%zu bytes were allocated in the arena\n", arena->used());
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Map the segment again so that the reader sees it at another address
+    char* view = static_cast<char*>(MapSegment(fd));
+    auto* shared = reinterpret_cast<Segment*>(view + kSegmentSize / 2u);
+    for (int i = 0; i < 3; ++i) {
+      shared->areas[i] = shared->drawables[i].invoke<Area>();
+    }
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+  for (int i = 0; i < 3; ++i) {
+    printf("The drawable is: ");
+    segment->drawables[i].invoke<Draw>();
+    printf(", area computed by the child = %f\n", segment->areas[i]);
+  }
+  segment->~Segment();
+  munmap(base, kSegmentSize);
+  close(fd);
+}
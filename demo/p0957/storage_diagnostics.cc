@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Author: Mingxin Wang (mingxwa@microsoft.com)
+ */
+
+#include <array>
+#include <cstdio>
+#include <vector>
+
+#include "../../main/p0957/proxy.h"
+
+struct Sum : std::dispatch<double()> {
+  template <class T>
+  double operator()(const T& self) { return self.Sum(); }
+};
+
+template <std::size_t N>
+class Samples {
+ public:
+  Samples() { values_.fill(1.); }
+  double Sum() const {
+    double result = 0.;
+    for (double value : values_) {
+      result += value;
+    }
+    return result;
+  }
+
+ private:
+  std::array<double, N> values_;
+};
+
+// Counts where each make_proxy put its value
+struct FMonitored : std::facade<Sum> {
+  static constexpr bool records_storage_statistics = true;
+};
+
+// Rejects any value that would need a heap allocation at compile time
+struct FInlineOnly : std::facade<Sum> {
+  static constexpr std::size_t maximum_size = sizeof(double) * 4u;
+  static constexpr std::heap_fallback_policy heap_fallback =
+      std::heap_fallback_policy::forbid;
+};
+
+void PrintStatistics() {
+  std::proxy_storage_statistics s = std::storage_statistics<FMonitored>();
+  printf("inline: %zu, heap: %zu, live heap bytes: %zu, peak: %zu\n",
+      s.inline_constructions, s.heap_constructions, s.live_heap_bytes,
+      s.peak_heap_bytes);
+}
+
+int main() {
+  static_assert(std::is_inline_proxiable_v<FInlineOnly, Samples<4>>);
+  static_assert(!std::is_inline_proxiable_v<FInlineOnly, Samples<5>>);
+  auto p = std::make_proxy<FInlineOnly, Samples<4>>();
+  // std::make_proxy<FInlineOnly, Samples<5>>() would not compile
+  printf("Sum of the inline samples: %f\n", p.invoke());
+
+  {
+    std::vector<std::proxy<FMonitored>> monitored;
+    monitored.push_back(std::make_proxy<FMonitored, Samples<1>>());
+    monitored.push_back(std::make_proxy<FMonitored, Samples<8>>());
+    monitored.push_back(std::make_proxy<FMonitored, Samples<16>>());
+    PrintStatistics();
+  }
+  PrintStatistics();
+}
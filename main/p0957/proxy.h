@@ -12,10 +12,29 @@
 #include <utility>
 #include <tuple>
 #include <concepts>
+#include <atomic>
+#include <exception>
+#include <array>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <memory_resource>
+#include <version>
+#if __cpp_lib_expected >= 202202L
+#include <expected>
+#endif
 
 namespace std {
 
 enum class constraint_level { none, nontrivial, nothrow, trivial };
+enum class heap_fallback_policy { allow, warn, forbid };
+enum class lazy_initialization { synchronized, unsynchronized };
+enum class proxy_storage { automatic, inplace, pooled, heap };
+enum class proxy_errc { empty = 1 };
 
 template <class T> struct dispatch;
 template <class R, class... Args>
@@ -24,6 +43,15 @@ struct dispatch<R(Args...)> {
   using argument_types = tuple<Args...>;
 };
 
+// The results of memoized dispatches are cached in the proxy without
+// synchronization, so a proxy of a facade with memoized dispatches must not
+// be invoked from several threads at once.
+template <class D>
+    requires(tuple_size_v<typename D::argument_types> == 0u &&
+        is_object_v<typename D::return_type> &&
+        is_copy_constructible_v<typename D::return_type>)
+struct memoized : D {};
+
 template <class... Ds>
 struct facade {
   using dispatch_types = tuple<Ds...>;
@@ -36,9 +64,14 @@ struct facade {
       constraint_level::nothrow;
   static constexpr constraint_level minimum_destructibility =
       constraint_level::nothrow;
+  static constexpr heap_fallback_policy heap_fallback =
+      heap_fallback_policy::allow;
+  static constexpr bool records_storage_statistics = false;
   facade() = delete;
 };
 
+template <class F> class proxy_multicast;
+
 namespace details {
 
 struct applicable_traits { static constexpr bool applicable = true; };
@@ -93,6 +126,27 @@ struct contains_traits<T, U, Us...> : contains_traits<T, Us...> {};
 template <class... U> struct default_traits { using type = void; };
 template <class T> struct default_traits<T> { using type = T; };
 
+template <class R> struct expected_traits : inapplicable_traits {};
+template <class R> struct try_invoke_traits : inapplicable_traits {};
+#if __cpp_lib_expected >= 202202L
+template <class T, class E>
+struct expected_traits<expected<T, E>> : applicable_traits
+    { using error_type = E; };
+template <class R>
+    requires(!expected_traits<R>::applicable &&
+        (is_void_v<R> || is_object_v<R>))
+struct try_invoke_traits<R> : applicable_traits
+    { using type = expected<R, proxy_errc>; };
+template <class R>
+    requires(expected_traits<R>::applicable && is_constructible_v<
+        typename expected_traits<R>::error_type, proxy_errc>)
+struct try_invoke_traits<R> : applicable_traits { using type = R; };
+#endif  // __cpp_lib_expected >= 202202L
+
+template <class T> struct multicast_traits : inapplicable_traits {};
+template <class F>
+struct multicast_traits<proxy_multicast<F>> : applicable_traits {};
+
 template <class D, class Args>
 struct dispatch_traits_impl : inapplicable_traits {};
 template <class D, class... Args>
@@ -101,10 +155,20 @@ struct dispatch_traits_impl<D, tuple<Args...>> : applicable_traits {
 
   template <class T>
   static constexpr bool applicable_operand = requires(T operand, Args... args)
-      { { D{}(forward<T>(operand), forward<Args>(args)...) }; };
+      { { D{}(forward<T>(operand), forward<Args>(args)...) }; } ||
+      (multicast_traits<decay_t<T>>::applicable &&
+          requires(T operand, Args... args)
+          { { operand.template invoke<D>(forward<Args>(args)...) }; });
   template <class P>
-  static typename D::return_type dispatcher(char* p, Args... args)
-      { return D{}(**reinterpret_cast<P*>(p), forward<Args>(args)...); }
+  static typename D::return_type dispatcher(char* p, Args... args) {
+    if constexpr (multicast_traits<decay_t<
+        typename pointer_traits<P>::value_type>>::applicable) {
+      return (**reinterpret_cast<P*>(p)).template invoke<D>(
+          forward<Args>(args)...);
+    } else {
+      return D{}(**reinterpret_cast<P*>(p), forward<Args>(args)...);
+    }
+  }
 };
 template <class D> struct dispatch_traits : inapplicable_traits {};
 template <class D> requires(requires {
@@ -131,6 +195,21 @@ struct copy_meta {
 
   void (*clone)(char*, const char*);
 };
+template <constraint_level C>
+struct copy_assignment_meta {
+  template <class P>
+  constexpr explicit copy_assignment_meta(in_place_type_t<P>)
+      : assign(nullptr) {}
+  template <class P>
+      requires(C == constraint_level::nothrow ?
+          is_nothrow_copy_assignable_v<P> : is_copy_assignable_v<P>)
+  constexpr explicit copy_assignment_meta(in_place_type_t<P>)
+      : assign([](char* self, const char* rhs) {
+              *reinterpret_cast<P*>(self) = *reinterpret_cast<const P*>(rhs);
+            }) {}
+
+  void (*assign)(char*, const char*);
+};
 struct relocation_meta {
   template <class P>
   constexpr explicit relocation_meta(in_place_type_t<P>)
@@ -148,6 +227,16 @@ struct destruction_meta {
 
   void (*destroy)(char*);
 };
+template <class F> inline atomic<size_t> facade_type_count{0u};
+template <class F, class P> inline atomic<size_t> facade_type_ordinal{0u};
+template <class F>
+struct ordinal_meta {
+  template <class P>
+  constexpr explicit ordinal_meta(in_place_type_t<P>)
+      : ordinal(&facade_type_ordinal<F, P>) {}
+
+  atomic<size_t>* ordinal;
+};
 template <class... Ms>
 struct facade_meta : Ms... {
   template <class P>
@@ -191,20 +280,86 @@ struct flattening_traits<tuple<T, Ts...>> : flattening_traits_impl<
     typename flattening_traits<T>::type,
     typename flattening_traits<tuple<Ts...>>::type> {};
 
+template <class D> struct memoized_traits : inapplicable_traits {};
+template <class D>
+struct memoized_traits<memoized<D>> : applicable_traits {};
+
+template <class... Ds>
+class memo_storage {
+ public:
+  void invalidate() noexcept { ++generation_; }
+  void clear() noexcept {
+    invalidate();
+    apply([](slot<Ds>&... s) { (s.value.reset(), ...); }, slots_);
+  }
+  template <class D, class C>
+  typename D::return_type get(C&& compute) {
+    slot<D>& s = std::get<slot<D>>(slots_);
+    if (s.generation != generation_) {
+      s.value.emplace(forward<C>(compute)());
+      s.generation = generation_;
+    }
+    return *s.value;
+  }
+
+ private:
+  template <class D>
+  struct slot {
+    optional<typename D::return_type> value;
+    size_t generation = 0u;
+  };
+
+  size_t generation_ = 1u;
+  tuple<slot<Ds>...> slots_;
+};
+template <>
+class memo_storage<> {
+ public:
+  void invalidate() noexcept {}
+  void clear() noexcept {}
+};
+
+template <class Ds> struct memo_storage_traits;
+template <class... Ds>
+struct memo_storage_traits<tuple<Ds...>> { using type = memo_storage<Ds...>; };
+
 template <class F, class Ds> struct basic_facade_traits_impl;
 template <class F, class... Ds>
 struct basic_facade_traits_impl<F, tuple<Ds...>> : applicable_traits {
   using meta_type = typename facade_meta_traits<
       conditional_meta_tag<F::minimum_copyability, copy_meta>,
+      conditional_meta_tag<F::minimum_copyability,
+          copy_assignment_meta<F::minimum_copyability>>,
       conditional_meta_tag<F::minimum_relocatability, relocation_meta>,
       conditional_meta_tag<F::minimum_destructibility, destruction_meta>,
       conditional_meta_tag<is_void_v<typename F::reflection_type> ?
           constraint_level::none : constraint_level::nothrow,
           typename F::reflection_type>>::type;
   using default_dispatch = typename default_traits<Ds...>::type;
+  using memo_type = typename memo_storage_traits<decltype(tuple_cat(
+      declval<conditional_t<memoized_traits<Ds>::applicable,
+          tuple<Ds>, tuple<>>>()...))>::type;
+  static constexpr bool has_memoized_dispatch =
+      (memoized_traits<Ds>::applicable || ...);
 
   template <class D>
   static constexpr bool has_dispatch = contains_traits<D, Ds...>::applicable;
+  static constexpr heap_fallback_policy heap_fallback = [] {
+    if constexpr (requires { { F::heap_fallback } ->
+        convertible_to<heap_fallback_policy>; }) {
+      return F::heap_fallback;
+    } else {
+      return heap_fallback_policy::allow;
+    }
+  }();
+  static constexpr bool records_storage_statistics = [] {
+    if constexpr (requires { { F::records_storage_statistics } ->
+        convertible_to<bool>; }) {
+      return F::records_storage_statistics;
+    } else {
+      return false;
+    }
+  }();
 };
 template <class F> struct basic_facade_traits : inapplicable_traits {};
 template <class F> requires(requires {
@@ -223,8 +378,8 @@ template <class F, class Ds>
 struct facade_traits_impl : inapplicable_traits {};
 template <class F, class... Ds> requires(dispatch_traits<Ds>::applicable && ...)
 struct facade_traits_impl<F, tuple<Ds...>> : applicable_traits {
-  using meta_type = facade_meta<
-      typename basic_facade_traits<F>::meta_type, dispatch_meta<Ds>...>;
+  using meta_type = facade_meta<typename basic_facade_traits<F>::meta_type,
+      ordinal_meta<F>, dispatch_meta<Ds>...>;
 
   template <class P>
   static constexpr bool applicable_pointer =
@@ -245,6 +400,8 @@ template <class T, class U> struct dependent_traits { using type = T; };
 template <class T, class U>
 using dependent_t = typename dependent_traits<T, U>::type;
 
+template <class D, class Args, class... Fs> class multi_dispatch_impl;
+
 }  // namespace details
 
 template <class P, class F>
@@ -339,8 +496,10 @@ class proxy {
   template <class P, class U, class... Args>
   explicit proxy(in_place_type_t<P>, initializer_list<U> il, Args&&... args)
       noexcept(HasNothrowPolyConstructor<P, initializer_list<U>&, Args...>)
-      requires(HasPolyConstructor<P, initializer_list<U>&, Args...>)
-      : proxy(in_place_type<P>, il, forward<Args>(args)...) {}
+      requires(HasPolyConstructor<P, initializer_list<U>&, Args...>) {
+    new(ptr_) P(il, forward<Args>(args)...);
+    meta_ = &Traits::template meta<P>;
+  }
   proxy& operator=(nullptr_t) noexcept(HasNothrowDestructor)
       requires(HasDestructor) {
     this->~proxy();
@@ -349,7 +508,7 @@ class proxy {
   }
   proxy& operator=(const proxy& rhs) noexcept
       requires(!HasTrivialCopyAssignment && HasNothrowCopyAssignment) {
-    if (this != &rhs) {
+    if (this != &rhs && !assign_in_place(rhs)) {
       this->~proxy();
       new(this) proxy(rhs);
     }
@@ -357,8 +516,10 @@ class proxy {
   }
   proxy& operator=(const proxy& rhs)
       requires(!HasNothrowCopyAssignment && HasCopyAssignment) {
-    proxy temp{rhs};
-    swap(temp);
+    if (this != &rhs && !assign_in_place(rhs)) {
+      proxy temp{rhs};
+      swap(temp);
+    }
     return *this;
   }
   proxy& operator=(const proxy&) noexcept requires(HasTrivialCopyAssignment) =
@@ -381,6 +542,13 @@ class proxy {
   template <class P>
   proxy& operator=(P&& ptr) noexcept
       requires(HasNothrowPolyAssignment<decay_t<P>, P>) {
+    if constexpr (is_nothrow_assignable_v<decay_t<P>&, P>) {
+      if (holds<decay_t<P>>()) {
+        *reinterpret_cast<decay_t<P>*>(ptr_) = forward<P>(ptr);
+        memo_.invalidate();
+        return *this;
+      }
+    }
     this->~proxy();
     new(this) proxy(forward<P>(ptr));
     return *this;
@@ -388,6 +556,13 @@ class proxy {
   template <class P>
   proxy& operator=(P&& ptr) requires(!HasNothrowPolyAssignment<decay_t<P>, P> &&
       HasPolyAssignment<decay_t<P>, P>) {
+    if constexpr (is_assignable_v<decay_t<P>&, P>) {
+      if (holds<decay_t<P>>()) {
+        *reinterpret_cast<decay_t<P>*>(ptr_) = forward<P>(ptr);
+        memo_.invalidate();
+        return *this;
+      }
+    }
     proxy temp{forward<P>(ptr)};
     swap(temp);
     return *this;
@@ -405,51 +580,145 @@ class proxy {
   decltype(auto) reflect() const noexcept
       requires(!is_void_v<typename F::reflection_type>)
       { return static_cast<const typename F::reflection_type&>(*meta_); }
-  void reset() noexcept(HasNothrowDestructor) requires(HasDestructor)
-      { this->~proxy(); meta_ = nullptr; }
+  void reset() noexcept(HasNothrowDestructor) requires(HasDestructor) {
+    if constexpr (!HasTrivialDestructor) {
+      if (meta_ != nullptr) {
+        meta_->destroy(ptr_);
+      }
+    }
+    meta_ = nullptr;
+    memo_.clear();
+  }
   void swap(proxy& rhs) noexcept(HasNothrowMoveConstructor)
       requires(HasMoveConstructor) {
     if constexpr (F::minimum_relocatability == constraint_level::trivial) {
       std::swap(meta_, rhs.meta_);
-      std::swap(ptr_, rhs.ptr);
+      std::swap(ptr_, rhs.ptr_);
     } else {
       if (meta_ != nullptr) {
         if (rhs.meta_ != nullptr) {
           proxy temp = move(*this);
-          new(this) proxy(move(rhs));
-          new(&rhs) proxy(move(temp));
+          relocate_from(rhs);
+          rhs.relocate_from(temp);
         } else {
-          new(&rhs) proxy(move(*this));
+          rhs.relocate_from(*this);
         }
       } else if (rhs.meta_ != nullptr) {
-        new(this) proxy(move(rhs));
+        relocate_from(rhs);
       }
     }
+    memo_.clear();
+    rhs.memo_.clear();
   }
   template <class P, class... Args>
   P& emplace(Args&&... args) noexcept(HasNothrowPolyAssignment<P, Args...>)
-      requires(HasPolyAssignment<P, Args...>) {
-    reset();
-    new(this) proxy(in_place_type<P>, forward<Args>(args)...);
-    return *reinterpret_cast<P*>(ptr_);
-  }
+      requires(HasPolyAssignment<P, Args...>)
+      { return emplace_impl<P>(forward<Args>(args)...); }
   template <class P, class U, class... Args>
   P& emplace(initializer_list<U> il, Args&&... args)
       noexcept(HasNothrowPolyAssignment<P, initializer_list<U>&, Args...>)
       requires(HasPolyAssignment<P, initializer_list<U>&, Args...>)
-      { return emplace<P>(il, forward<Args>(args)...); }
+      { return emplace_impl<P>(il, forward<Args>(args)...); }
   template <class D = typename BasicTraits::default_dispatch, class... Args>
   decltype(auto) invoke(Args&&... args)
       requires(details::dependent_t<Traits, D>::applicable &&
           BasicTraits::template has_dispatch<D> &&
           is_convertible_v<tuple<Args...>, typename D::argument_types>) {
+    if constexpr (details::memoized_traits<D>::applicable) {
+      return memo_.template get<D>([this] { return dispatch<D>(); });
+    } else {
+      memo_.invalidate();
+      return dispatch<D>(forward<Args>(args)...);
+    }
+  }
+#if __cpp_lib_expected >= 202202L
+  template <class D = typename BasicTraits::default_dispatch, class... Args>
+  auto try_invoke(Args&&... args)
+      requires(details::dependent_t<Traits, D>::applicable &&
+          BasicTraits::template has_dispatch<D> &&
+          is_convertible_v<tuple<Args...>, typename D::argument_types> &&
+          details::try_invoke_traits<typename D::return_type>::applicable) {
+    using R = typename details::try_invoke_traits<
+        typename D::return_type>::type;
+    if (meta_ == nullptr) [[unlikely]] {
+      return R(unexpect, proxy_errc::empty);
+    }
+    if constexpr (is_void_v<typename D::return_type>) {
+      invoke<D>(forward<Args>(args)...);
+      return R();
+    } else {
+      return R(invoke<D>(forward<Args>(args)...));
+    }
+  }
+#endif  // __cpp_lib_expected >= 202202L
+  template <class P, class D = typename BasicTraits::default_dispatch,
+      class... Args>
+  decltype(auto) invoke_expect(Args&&... args)
+      requires(proxiable<P, F> && BasicTraits::template has_dispatch<D> &&
+          is_convertible_v<tuple<Args...>, typename D::argument_types>) {
+    if constexpr (!details::memoized_traits<D>::applicable) {
+      if (holds<P>()) [[likely]] {
+        memo_.invalidate();
+        return details::dispatch_traits<D>::template dispatcher<P>(
+            ptr_, forward<Args>(args)...);
+      }
+    }
+    return invoke<D>(forward<Args>(args)...);
+  }
+
+ private:
+  template <class, class, bool> friend class inline_cache;
+  template <class, class, class...> friend class details::multi_dispatch_impl;
+  template <class> friend class proxy_multicast;
+
+  template <class P>
+  bool holds() const noexcept { return meta_ == &Traits::template meta<P>; }
+  void relocate_from(proxy& rhs) noexcept(HasNothrowMoveConstructor) {
+    rhs.meta_->relocate(ptr_, rhs.ptr_);
+    meta_ = rhs.meta_;
+    rhs.meta_ = nullptr;
+  }
+  template <class D, class... Args>
+  decltype(auto) dispatch(Args&&... args) {
     return static_cast<const typename Traits::meta_type*>(meta_)
         ->template dispatch_meta<D>::dispatcher(ptr_, forward<Args>(args)...);
   }
+  bool assign_in_place(const proxy& rhs) noexcept(HasNothrowCopyAssignment) {
+    if constexpr (F::minimum_copyability > constraint_level::none &&
+        F::minimum_copyability < constraint_level::trivial) {
+      if (meta_ != nullptr && meta_ == rhs.meta_ && meta_->assign != nullptr) {
+        meta_->assign(ptr_, rhs.ptr_);
+        memo_.invalidate();
+        return true;
+      }
+    }
+    return false;
+  }
+  template <class P, class... Args>
+  P& emplace_impl(Args&&... args) {
+    constexpr bool HasReemplace = requires(P& ptr, Args&&... as)
+        { ptr.reemplace(forward<Args>(as)...); };
+    if constexpr (HasReemplace || is_nothrow_move_assignable_v<P>) {
+      if (holds<P>()) {
+        P& value = *reinterpret_cast<P*>(ptr_);
+        if constexpr (HasReemplace) {
+          value.reemplace(forward<Args>(args)...);
+        } else {
+          value = P(forward<Args>(args)...);
+        }
+        memo_.invalidate();
+        return value;
+      }
+    }
+    reset();
+    new(ptr_) P(forward<Args>(args)...);
+    meta_ = &Traits::template meta<P>;
+    return *reinterpret_cast<P*>(ptr_);
+  }
 
- private:
   const typename BasicTraits::meta_type* meta_;
   alignas(F::maximum_alignment) char ptr_[F::maximum_size];
+  [[no_unique_address]] typename BasicTraits::memo_type memo_;
 };
 
 namespace details {
@@ -462,6 +731,10 @@ class sbo_ptr {
   sbo_ptr(const sbo_ptr&) noexcept(is_nothrow_copy_constructible_v<T>)
       = default;
   sbo_ptr(sbo_ptr&&) noexcept(is_nothrow_move_constructible_v<T>) = default;
+  sbo_ptr& operator=(const sbo_ptr&)
+      noexcept(is_nothrow_copy_assignable_v<T>) = default;
+  sbo_ptr& operator=(sbo_ptr&&) noexcept(is_nothrow_move_assignable_v<T>)
+      = default;
 
   T& operator*() { return value_; }
 
@@ -469,16 +742,68 @@ class sbo_ptr {
   T value_;
 };
 
-template <class T>
+template <class F>
+struct storage_statistics_recorder {
+  static void on_inline_construction() noexcept
+      { inline_constructions.fetch_add(1u, memory_order_relaxed); }
+  static void on_heap_construction() noexcept
+      { heap_constructions.fetch_add(1u, memory_order_relaxed); }
+  static void on_allocation(size_t size) noexcept {
+    size_t live = live_heap_bytes.fetch_add(size, memory_order_relaxed) + size;
+    size_t peak = peak_heap_bytes.load(memory_order_relaxed);
+    while (peak < live && !peak_heap_bytes.compare_exchange_weak(
+        peak, live, memory_order_relaxed)) {}
+  }
+  static void on_deallocation(size_t size) noexcept
+      { live_heap_bytes.fetch_sub(size, memory_order_relaxed); }
+
+  static inline atomic<size_t> inline_constructions{0u};
+  static inline atomic<size_t> heap_constructions{0u};
+  static inline atomic<size_t> live_heap_bytes{0u};
+  static inline atomic<size_t> peak_heap_bytes{0u};
+};
+
+struct null_storage_recorder {
+  static void on_allocation(size_t) noexcept {}
+  static void on_deallocation(size_t) noexcept {}
+};
+
+template <class T, class R = null_storage_recorder>
 class deep_ptr {
  public:
   template <class... Args>
-  deep_ptr(Args&&... args) : ptr_(new T(forward<Args>(args)...)) {}
+  deep_ptr(Args&&... args) : ptr_(new T(forward<Args>(args)...))
+      { R::on_allocation(sizeof(T)); }
   deep_ptr(const deep_ptr& rhs) noexcept(is_nothrow_copy_constructible_v<T>)
       requires(is_copy_constructible_v<T>)
-      : ptr_(rhs.ptr_ == nullptr ? nullptr : new T(*rhs)) {}
+      : ptr_(rhs.ptr_ == nullptr ? nullptr : new T(*rhs)) {
+    if (ptr_ != nullptr) {
+      R::on_allocation(sizeof(T));
+    }
+  }
   deep_ptr(deep_ptr&& rhs) noexcept : ptr_(rhs.ptr_) { rhs.ptr_ = nullptr; }
-  ~deep_ptr() noexcept { delete ptr_; }
+  deep_ptr& operator=(const deep_ptr& rhs)
+      noexcept(is_nothrow_copy_assignable_v<T>)
+      requires(is_copy_constructible_v<T> && is_copy_assignable_v<T>) {
+    if (ptr_ != nullptr && rhs.ptr_ != nullptr) {
+      **this = *rhs;
+    } else if (this != &rhs) {
+      deep_ptr temp{rhs};
+      std::swap(ptr_, temp.ptr_);
+    }
+    return *this;
+  }
+  deep_ptr& operator=(deep_ptr&& rhs) noexcept
+      { std::swap(ptr_, rhs.ptr_); return *this; }
+  template <class... Args>
+  void reemplace(Args&&... args) requires(is_constructible_v<T, Args...> &&
+      is_nothrow_move_assignable_v<T>) { **this = T(forward<Args>(args)...); }
+  ~deep_ptr() noexcept {
+    if (ptr_ != nullptr) {
+      R::on_deallocation(sizeof(T));
+      delete ptr_;
+    }
+  }
 
   T& operator*() const { return *ptr_; }
 
@@ -486,14 +811,65 @@ class deep_ptr {
   T* ptr_;
 };
 
+template <class T>
+[[deprecated("The value type does not fit in the facade and is stored on "
+    "the heap; consider increasing maximum_size or maximum_alignment")]]
+constexpr void warn_heap_fallback() noexcept {}
+
 template <class F, class T, class... Args>
 proxy<F> make_proxy_impl(Args&&... args) {
-  return proxy<F>{in_place_type<conditional_t<proxiable<sbo_ptr<T>, F>,
-      sbo_ptr<T>, deep_ptr<T>>>, forward<Args>(args)...};
+  using BasicTraits = basic_facade_traits<F>;
+  constexpr bool is_inline = proxiable<sbo_ptr<T>, F>;
+  if constexpr (!is_inline) {
+    static_assert(BasicTraits::heap_fallback != heap_fallback_policy::forbid,
+        "The value type does not fit in the facade and heap fallback is "
+        "forbidden");
+    if constexpr (BasicTraits::heap_fallback == heap_fallback_policy::warn) {
+      warn_heap_fallback<T>();
+    }
+  }
+  if constexpr (BasicTraits::records_storage_statistics) {
+    using Recorder = storage_statistics_recorder<F>;
+    if constexpr (is_inline) {
+      Recorder::on_inline_construction();
+      return proxy<F>{in_place_type<sbo_ptr<T>>, forward<Args>(args)...};
+    } else {
+      Recorder::on_heap_construction();
+      return proxy<F>{in_place_type<deep_ptr<T, Recorder>>,
+          forward<Args>(args)...};
+    }
+  } else {
+    return proxy<F>{in_place_type<conditional_t<is_inline,
+        sbo_ptr<T>, deep_ptr<T>>>, forward<Args>(args)...};
+  }
 }
 
 }  // namespace details
 
+template <class F, class T>
+struct is_inline_proxiable
+    : bool_constant<proxiable<details::sbo_ptr<T>, F>> {};
+template <class F, class T>
+inline constexpr bool is_inline_proxiable_v = is_inline_proxiable<F, T>::value;
+
+struct proxy_storage_statistics {
+  size_t inline_constructions;
+  size_t heap_constructions;
+  size_t live_heap_bytes;
+  size_t peak_heap_bytes;
+};
+
+template <class F>
+proxy_storage_statistics storage_statistics() noexcept
+    requires(details::basic_facade_traits<F>::records_storage_statistics) {
+  using Recorder = details::storage_statistics_recorder<F>;
+  return {
+      Recorder::inline_constructions.load(memory_order_relaxed),
+      Recorder::heap_constructions.load(memory_order_relaxed),
+      Recorder::live_heap_bytes.load(memory_order_relaxed),
+      Recorder::peak_heap_bytes.load(memory_order_relaxed)};
+}
+
 template <class F, class T, class... Args>
 proxy<F> make_proxy(Args&&... args)
     { return details::make_proxy_impl<F, T>(forward<Args>(args)...); }
@@ -504,6 +880,795 @@ template <class F, class T>
 proxy<F> make_proxy(T&& value)
     { return details::make_proxy_impl<F, decay_t<T>>(forward<T>(value)); }
 
+namespace details {
+
+template <class T, class... Args>
+T* make_lazy_value(tuple<Args...>& captures) {
+  return apply([](Args&... args) {
+    if constexpr (is_nothrow_constructible_v<T, Args...>) {
+      return new T(move(args)...);
+    } else {
+      return new T(args...);
+    }
+  }, captures);
+}
+
+template <class T, class C, lazy_initialization L>
+class lazy_ptr {
+ public:
+  template <class... Args>
+  explicit lazy_ptr(Args&&... args)
+      : value_(nullptr), args_(forward<Args>(args)...) {}
+  lazy_ptr(const lazy_ptr& rhs)
+      requires(is_copy_constructible_v<T> && is_copy_constructible_v<C>)
+      : value_(rhs.value_ == nullptr ? nullptr : new T(*rhs.value_)),
+        args_(rhs.args_) {}
+  lazy_ptr(lazy_ptr&& rhs) noexcept(is_nothrow_move_constructible_v<C>)
+      : value_(rhs.value_), args_(move(rhs.args_)) { rhs.value_ = nullptr; }
+  ~lazy_ptr() noexcept { delete value_; }
+
+  T& operator*() {
+    if (value_ == nullptr) [[unlikely]] {
+      value_ = make_lazy_value<T>(*args_);
+    }
+    return *value_;
+  }
+
+ private:
+  T* value_;
+  C args_;
+};
+
+template <class T, class C>
+class lazy_ptr<T, C, lazy_initialization::synchronized> {
+ public:
+  template <class... Args>
+  explicit lazy_ptr(Args&&... args)
+      : state_(kUninitialized), args_(forward<Args>(args)...) {}
+  lazy_ptr(const lazy_ptr& rhs)
+      requires(is_copy_constructible_v<T> && is_copy_constructible_v<C>)
+      : state_(copy_state(rhs)), args_(rhs.args_) {}
+  lazy_ptr(lazy_ptr&& rhs) noexcept(is_nothrow_move_constructible_v<C>)
+      : state_(rhs.state_.exchange(kUninitialized, memory_order_relaxed)),
+        args_(move(rhs.args_)) {}
+  ~lazy_ptr() noexcept {
+    uintptr_t state = state_.load(memory_order_relaxed);
+    if (state != kUninitialized) {
+      delete reinterpret_cast<T*>(state);
+    }
+  }
+
+  T& operator*() {
+    uintptr_t state = state_.load(memory_order_acquire);
+    if (state <= kInitializing) [[unlikely]] {
+      state = initialize();
+    }
+    return *reinterpret_cast<T*>(state);
+  }
+
+ private:
+  static constexpr uintptr_t kUninitialized = 0u;
+  static constexpr uintptr_t kInitializing = 1u;
+
+  static uintptr_t copy_state(const lazy_ptr& rhs) {
+    uintptr_t state = rhs.state_.load(memory_order_acquire);
+    if (state <= kInitializing) {
+      return kUninitialized;
+    }
+    return reinterpret_cast<uintptr_t>(
+        new T(*reinterpret_cast<const T*>(state)));
+  }
+  uintptr_t initialize() {
+    uintptr_t state = kUninitialized;
+    while (!state_.compare_exchange_weak(state, kInitializing,
+        memory_order_acquire, memory_order_acquire)) {
+      if (state == kInitializing) {
+        state_.wait(kInitializing, memory_order_acquire);
+        state = kUninitialized;
+      } else if (state != kUninitialized) {
+        return state;
+      }
+    }
+    try {
+      state = reinterpret_cast<uintptr_t>(make_lazy_value<T>(*args_));
+    } catch (...) {
+      state_.store(kUninitialized, memory_order_release);
+      state_.notify_all();
+      throw;
+    }
+    state_.store(state, memory_order_release);
+    state_.notify_all();
+    return state;
+  }
+
+  atomic<uintptr_t> state_;
+  C args_;
+};
+
+template <class F, class T, lazy_initialization L, class Captures,
+    class... Args>
+proxy<F> make_lazy_proxy_impl(Args&&... args) {
+  static_assert(L == lazy_initialization::unsynchronized ||
+      !basic_facade_traits<F>::has_memoized_dispatch,
+      "Synchronized lazy proxies are shared between threads, which facades "
+      "with memoized dispatches do not support");
+  using P = conditional_t<proxiable<lazy_ptr<T, sbo_ptr<Captures>, L>, F>,
+      lazy_ptr<T, sbo_ptr<Captures>, L>, lazy_ptr<T, deep_ptr<Captures>, L>>;
+  return proxy<F>{in_place_type<P>, forward<Args>(args)...};
+}
+
+}  // namespace details
+
+template <class F, class T,
+    lazy_initialization L = lazy_initialization::synchronized, class... Args>
+proxy<F> make_lazy_proxy(Args&&... args)
+    requires(is_constructible_v<T, decay_t<Args>&...> ||
+        is_nothrow_constructible_v<T, decay_t<Args>...>) {
+  return details::make_lazy_proxy_impl<F, T, L, tuple<decay_t<Args>...>>(
+      forward<Args>(args)...);
+}
+
+namespace details {
+
+template <class T>
+class pool_ptr {
+ public:
+  template <class... Args>
+  pool_ptr(Args&&... args)
+      : ptr_(allocator().template new_object<T>(forward<Args>(args)...)) {}
+  pool_ptr(const pool_ptr& rhs) requires(is_copy_constructible_v<T>)
+      : ptr_(rhs.ptr_ == nullptr ? nullptr :
+            allocator().template new_object<T>(*rhs)) {}
+  pool_ptr(pool_ptr&& rhs) noexcept : ptr_(rhs.ptr_) { rhs.ptr_ = nullptr; }
+  pool_ptr& operator=(const pool_ptr& rhs)
+      noexcept(is_nothrow_copy_assignable_v<T>)
+      requires(is_copy_constructible_v<T> && is_copy_assignable_v<T>) {
+    if (ptr_ != nullptr && rhs.ptr_ != nullptr) {
+      **this = *rhs;
+    } else if (this != &rhs) {
+      pool_ptr temp{rhs};
+      std::swap(ptr_, temp.ptr_);
+    }
+    return *this;
+  }
+  pool_ptr& operator=(pool_ptr&& rhs) noexcept
+      { std::swap(ptr_, rhs.ptr_); return *this; }
+  template <class... Args>
+  void reemplace(Args&&... args) requires(is_constructible_v<T, Args...> &&
+      is_nothrow_move_assignable_v<T>) { **this = T(forward<Args>(args)...); }
+  ~pool_ptr() noexcept {
+    if (ptr_ != nullptr) {
+      allocator().delete_object(ptr_);
+    }
+  }
+
+  T& operator*() const { return *ptr_; }
+
+ private:
+  static pmr::polymorphic_allocator<> allocator() noexcept {
+    // Never destroyed, so that proxies with static storage duration can
+    // still release their values during exit
+    static pmr::synchronized_pool_resource* pool =
+        new pmr::synchronized_pool_resource();
+    return pool;
+  }
+
+  T* ptr_;
+};
+
+template <class F, class T, proxy_storage S, class... Args>
+proxy<F> make_proxy_with_storage(Args&&... args) {
+  if constexpr (S == proxy_storage::automatic) {
+    return make_proxy_impl<F, T>(forward<Args>(args)...);
+  } else if constexpr (S == proxy_storage::inplace) {
+    static_assert(proxiable<sbo_ptr<T>, F>,
+        "The value type does not fit in the facade");
+    return proxy<F>{in_place_type<sbo_ptr<T>>, forward<Args>(args)...};
+  } else if constexpr (S == proxy_storage::pooled) {
+    return proxy<F>{in_place_type<pool_ptr<T>>, forward<Args>(args)...};
+  } else {
+    return proxy<F>{in_place_type<deep_ptr<T>>, forward<Args>(args)...};
+  }
+}
+
+template <class F, class T, proxy_storage S, class... Args>
+proxy<F> create_proxy(Args... args)
+    { return make_proxy_with_storage<F, T, S>(forward<Args>(args)...); }
+
+constexpr uint64_t factory_mix(uint64_t value) noexcept {
+  value ^= value >> 33u;
+  value *= 0xff51afd7ed558ccdu;
+  value ^= value >> 33u;
+  value *= 0xc4ceb9fe1a85ec53u;
+  return value ^ (value >> 33u);
+}
+constexpr uint64_t factory_hash(string_view name) noexcept {
+  uint64_t result = 14695981039346656037u;
+  for (char c : name) {
+    result = (result ^ static_cast<unsigned char>(c)) * 1099511628211u;
+  }
+  return factory_mix(result);
+}
+constexpr uint64_t factory_slot_hash(uint64_t hash, uint64_t seed) noexcept
+    { return factory_mix(hash ^ (seed * 11400714819323198485u)); }
+
+inline void duplicate_proxy_factory_entry() {}
+inline void proxy_factory_seed_exhausted() {}
+
+}  // namespace details
+
+template <class F, class... Args>
+struct proxy_factory_entry {
+  template <class T, proxy_storage S = proxy_storage::automatic>
+  static constexpr proxy_factory_entry of(string_view name)
+      requires(is_constructible_v<T, Args...>)
+      { return {name, &details::create_proxy<F, T, S, Args...>}; }
+
+  string_view name;
+  proxy<F> (*create)(Args...);
+};
+
+template <class F, size_t N, class... Args> requires(N > 0u)
+class proxy_factory {
+  using entry_type = proxy_factory_entry<F, Args...>;
+  static constexpr size_t kBuckets = N;
+  static constexpr size_t kSlots = bit_ceil(N + N / 4u + 1u);
+  static constexpr uint64_t kMaxSeed = uint64_t{1u} << 20u;
+
+ public:
+  consteval proxy_factory(const entry_type (&entries)[N])
+      : seeds_{}, slots_{} {
+    array<uint64_t, N> hashes{};
+    array<size_t, kBuckets + 1u> offsets{};
+    for (size_t i = 0u; i < N; ++i) {
+      hashes[i] = details::factory_hash(entries[i].name);
+      ++offsets[hashes[i] % kBuckets + 1u];
+    }
+    for (size_t b = 0u; b < kBuckets; ++b) {
+      offsets[b + 1u] += offsets[b];
+    }
+    array<size_t, N> members{};
+    array<size_t, kBuckets> filled{};
+    for (size_t i = 0u; i < N; ++i) {
+      size_t b = hashes[i] % kBuckets;
+      members[offsets[b] + filled[b]++] = i;
+    }
+    array<size_t, N + 2u> by_size{};
+    for (size_t b = 0u; b < kBuckets; ++b) {
+      ++by_size[N - filled[b] + 1u];
+    }
+    for (size_t i = 0u; i <= N; ++i) {
+      by_size[i + 1u] += by_size[i];
+    }
+    array<size_t, kBuckets> order{};
+    for (size_t b = 0u; b < kBuckets; ++b) {
+      order[by_size[N - filled[b]]++] = b;
+    }
+    array<bool, kSlots> occupied{};
+    array<size_t, N> candidates{};
+    for (size_t b : order) {
+      place_bucket(entries, hashes, members.data() + offsets[b],
+          members.data() + offsets[b + 1u], b, occupied, candidates);
+    }
+  }
+
+  bool contains(string_view name) const noexcept
+      { return lookup(name) != nullptr; }
+  proxy<F> create(string_view name, Args... args) const {
+    const entry_type* entry = lookup(name);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    return entry->create(forward<Args>(args)...);
+  }
+
+ private:
+  constexpr const entry_type* lookup(string_view name) const noexcept {
+    uint64_t hash = details::factory_hash(name);
+    const entry_type& entry = slots_[details::factory_slot_hash(
+        hash, seeds_[hash % kBuckets]) & (kSlots - 1u)];
+    return entry.create != nullptr && entry.name == name ? &entry : nullptr;
+  }
+  consteval void place_bucket(const entry_type (&entries)[N],
+      const array<uint64_t, N>& hashes,
+      const size_t* first, const size_t* last, size_t bucket,
+      array<bool, kSlots>& occupied, array<size_t, N>& candidates) {
+    for (const size_t* i = first; i != last; ++i) {
+      for (const size_t* j = i + 1; j != last; ++j) {
+        if (entries[*i].name == entries[*j].name) {
+          details::duplicate_proxy_factory_entry();
+        }
+      }
+    }
+    for (uint64_t seed = 1u; seed < kMaxSeed; ++seed) {
+      size_t count = 0u;
+      for (const size_t* i = first; i != last; ++i, ++count) {
+        size_t slot = details::factory_slot_hash(hashes[*i], seed) &
+            (kSlots - 1u);
+        if (occupied[slot] || find(candidates.begin(),
+            candidates.begin() + count, slot) != candidates.begin() + count) {
+          break;
+        }
+        candidates[count] = slot;
+      }
+      if (first + count == last) {
+        for (size_t k = 0u; k < count; ++k) {
+          occupied[candidates[k]] = true;
+          slots_[candidates[k]] = entries[first[k]];
+        }
+        seeds_[bucket] = seed;
+        return;
+      }
+    }
+    details::proxy_factory_seed_exhausted();
+  }
+
+  array<uint64_t, kBuckets> seeds_;
+  array<entry_type, kSlots> slots_;
+};
+
+namespace details {
+
+template <bool C>
+struct inline_cache_counters {
+ protected:
+  void on_hit() noexcept {}
+  void on_miss() noexcept {}
+};
+template <>
+struct inline_cache_counters<true> {
+ public:
+  size_t hits() const noexcept { return hits_.load(memory_order_relaxed); }
+  size_t misses() const noexcept
+      { return misses_.load(memory_order_relaxed); }
+
+ protected:
+  void on_hit() noexcept { hits_.fetch_add(1u, memory_order_relaxed); }
+  void on_miss() noexcept { misses_.fetch_add(1u, memory_order_relaxed); }
+
+ private:
+  atomic<size_t> hits_{0u};
+  atomic<size_t> misses_{0u};
+};
+
+}  // namespace details
+
+template <class P, class D, bool C = false>
+class inline_cache : public details::inline_cache_counters<C> {
+ public:
+  template <class F, class... Args>
+  decltype(auto) operator()(proxy<F>& p, Args&&... args)
+      requires(requires { p.template invoke_expect<P, D>(
+          forward<Args>(args)...); }) {
+    if constexpr (details::memoized_traits<D>::applicable) {
+      return p.template invoke<D>(forward<Args>(args)...);
+    } else {
+      if (p.template holds<P>()) [[likely]] {
+        this->on_hit();
+        p.memo_.invalidate();
+        return details::dispatch_traits<D>::template dispatcher<P>(
+            p.ptr_, forward<Args>(args)...);
+      }
+      this->on_miss();
+      return p.template invoke<D>(forward<Args>(args)...);
+    }
+  }
+};
+
+class bad_multi_dispatch : public exception {
+ public:
+  const char* what() const noexcept override
+      { return "std::bad_multi_dispatch"; }
+};
+
+namespace details {
+
+template <class D, class... Args, class... Fs>
+class multi_dispatch_impl<D, tuple<Args...>, Fs...> {
+  using R = typename D::return_type;
+  using dispatcher_type = R (*)(dependent_t<char*, Fs>..., Args...);
+  static constexpr size_t N = sizeof...(Fs);
+
+  template <class... Ps>
+  static R dispatcher(dependent_t<char*, Ps>... ptrs, Args... args)
+      { return D{}(**reinterpret_cast<Ps*>(ptrs)..., forward<Args>(args)...); }
+  [[noreturn]] static R fallback(dependent_t<char*, Fs>..., Args...)
+      { throw bad_multi_dispatch{}; }
+
+  template <class F, class P>
+  static size_t ordinal_of() noexcept {
+    atomic<size_t>& ordinal = facade_type_ordinal<F, P>;
+    size_t result = ordinal.load(memory_order_acquire);
+    if (result == 0u) {
+      size_t assigned = facade_type_count<F>.fetch_add(
+          1u, memory_order_relaxed) + 1u;
+      if (ordinal.compare_exchange_strong(result, assigned,
+          memory_order_acq_rel, memory_order_acquire)) {
+        result = assigned;
+      }
+    }
+    return result;
+  }
+  template <class F>
+  static size_t ordinal_of(const proxy<F>& p) noexcept {
+    return static_cast<const typename facade_traits<F>::meta_type*>(p.meta_)
+        ->ordinal->load(memory_order_relaxed);
+  }
+
+ public:
+  template <class... Ps>
+  void register_overload() requires(sizeof...(Ps) == N &&
+      (proxiable<Ps, Fs> && ...) && requires(Args... args) {
+        { D{}(*declval<Ps&>()..., forward<Args>(args)...) } ->
+            convertible_to<R>;
+      }) {
+    overloads_.push_back({{ordinal_of<Fs, Ps>()...}, &dispatcher<Ps...>});
+    rebuild();
+  }
+  R operator()(proxy<Fs>&... ps, Args... args) const {
+    if ((!ps.has_value() || ...)) {
+      throw bad_multi_dispatch{};
+    }
+    array<size_t, N> ordinals{ordinal_of(ps)...};
+    (ps.memo_.invalidate(), ...);
+    size_t index = 0u;
+    for (size_t i = 0u; i < N; ++i) {
+      if (ordinals[i] >= extents_[i]) {
+        return fallback(ps.ptr_..., forward<Args>(args)...);
+      }
+      index = index * extents_[i] + ordinals[i];
+    }
+    return table_[index](ps.ptr_..., forward<Args>(args)...);
+  }
+
+ private:
+  struct overload {
+    array<size_t, N> ordinals;
+    dispatcher_type dispatcher;
+  };
+
+  void rebuild() {
+    array<size_t, N> extents{(facade_type_count<Fs>.load(
+        memory_order_relaxed) + 1u)...};
+    size_t size = 1u;
+    for (size_t extent : extents) {
+      size *= extent;
+    }
+    vector<dispatcher_type> table(size, &fallback);
+    for (const overload& o : overloads_) {
+      size_t index = 0u;
+      for (size_t i = 0u; i < N; ++i) {
+        index = index * extents[i] + o.ordinals[i];
+      }
+      table[index] = o.dispatcher;
+    }
+    table_ = move(table);
+    extents_ = extents;
+  }
+
+  vector<overload> overloads_;
+  vector<dispatcher_type> table_{&fallback};
+  array<size_t, N> extents_{((void)sizeof(Fs), 1u)...};
+};
+
+}  // namespace details
+
+template <class D, class... Fs>
+    requires(sizeof...(Fs) >= 2u &&
+        (details::basic_facade_traits<Fs>::applicable && ...))
+class multi_dispatch : public details::multi_dispatch_impl<
+    D, typename D::argument_types, Fs...> {};
+
+template <class F>
+class proxy_multicast {
+  using Traits = details::facade_traits<F>;
+  static_assert(!details::basic_facade_traits<F>::has_memoized_dispatch,
+      "Subscribers are invoked from concurrent publishers, which facades "
+      "with memoized dispatches do not support");
+
+ public:
+  proxy_multicast() : current_(new snapshot{}) {}
+  proxy_multicast(const proxy_multicast&) = delete;
+  proxy_multicast& operator=(const proxy_multicast&) = delete;
+  ~proxy_multicast() {
+    delete current_.load(memory_order_relaxed);
+    snapshot* retired = retired_.load(memory_order_relaxed);
+    while (retired != nullptr) {
+      delete exchange(retired, retired->next_retired);
+    }
+  }
+
+  size_t subscribe(proxy<F> p) {
+    subscriber s{next_id_.fetch_add(1u, memory_order_relaxed),
+        make_shared<proxy<F>>(move(p))};
+    update([&s](vector<subscriber>& subscribers) {
+      subscribers.insert(upper_bound(subscribers.begin(), subscribers.end(),
+          s, [](const subscriber& lhs, const subscriber& rhs)
+              { return lhs.key() < rhs.key(); }), s);
+      return true;
+    });
+    return s.id;
+  }
+  bool unsubscribe(size_t id) {
+    return update([id](vector<subscriber>& subscribers) {
+      auto it = find_if(subscribers.begin(), subscribers.end(),
+          [id](const subscriber& s) { return s.id == id; });
+      if (it == subscribers.end()) {
+        return false;
+      }
+      subscribers.erase(it);
+      return true;
+    });
+  }
+  size_t size() const noexcept
+      { return read_guard{*this}->subscribers.size(); }
+  template <class D, class... Args>
+  typename D::return_type invoke(Args&&... args)
+      requires(details::dependent_t<Traits, D>::applicable &&
+          details::basic_facade_traits<F>::template has_dispatch<D> &&
+          is_convertible_v<tuple<Args...>, typename D::argument_types> &&
+          (is_void_v<typename D::return_type> ||
+              is_default_constructible_v<typename D::return_type>)) {
+    return broadcast<D>(static_cast<typename D::argument_types*>(nullptr),
+        args...);
+  }
+
+ private:
+  struct subscriber {
+    uintptr_t key() const noexcept
+        { return reinterpret_cast<uintptr_t>(target->meta_); }
+
+    size_t id;
+    shared_ptr<proxy<F>> target;
+  };
+  struct snapshot {
+    vector<subscriber> subscribers;
+    size_t retired_epoch = 0u;
+    snapshot* next_retired = nullptr;
+  };
+
+  // Snapshots are reclaimed by epochs: a snapshot retired in epoch e is
+  // deleted once the epoch reaches e + 2, which requires every reader that
+  // entered in epoch e or earlier to have left.
+  class read_guard {
+   public:
+    explicit read_guard(const proxy_multicast& owner) noexcept {
+      for (;;) {
+        size_t epoch = owner.epoch_.load();
+        readers_ = &owner.readers_[epoch & 1u];
+        readers_->fetch_add(1u);
+        if (owner.epoch_.load() == epoch) {
+          break;
+        }
+        readers_->fetch_sub(1u, memory_order_release);
+      }
+      snapshot_ = owner.current_.load();
+    }
+    read_guard(const read_guard&) = delete;
+    ~read_guard() { readers_->fetch_sub(1u, memory_order_release); }
+
+    snapshot* get() const noexcept { return snapshot_; }
+    snapshot* operator->() const noexcept { return snapshot_; }
+
+   private:
+    atomic<size_t>* readers_;
+    snapshot* snapshot_;
+  };
+
+  template <class U>
+  bool update(U&& updater) {
+    for (;;) {
+      read_guard guard{*this};
+      snapshot* current = guard.get();
+      auto next = make_unique<snapshot>(current->subscribers);
+      if (!updater(next->subscribers)) {
+        return false;
+      }
+      if (current_.compare_exchange_strong(current, next.get())) {
+        next.release();
+        retire(current);
+        break;
+      }
+    }
+    reclaim();
+    return true;
+  }
+  void retire(snapshot* s) noexcept {
+    s->retired_epoch = epoch_.load();
+    s->next_retired = retired_.load(memory_order_relaxed);
+    while (!retired_.compare_exchange_weak(s->next_retired, s,
+        memory_order_release, memory_order_relaxed)) {}
+  }
+  void reclaim() noexcept {
+    size_t epoch = epoch_.load();
+    for (int i = 0; i < 2 && readers_[(epoch + 1u) & 1u].load() == 0u; ++i) {
+      if (epoch_.compare_exchange_strong(epoch, epoch + 1u)) {
+        ++epoch;
+      }
+    }
+    snapshot* retired = retired_.exchange(nullptr, memory_order_acquire);
+    while (retired != nullptr) {
+      snapshot* s = exchange(retired, retired->next_retired);
+      if (s->retired_epoch + 2u <= epoch) {
+        delete s;
+      } else {
+        s->next_retired = retired_.load(memory_order_relaxed);
+        while (!retired_.compare_exchange_weak(s->next_retired, s,
+            memory_order_release, memory_order_relaxed)) {}
+      }
+    }
+  }
+  // Every subscriber gets its own copy of an argument it may move from
+  template <class A, class T>
+  static decltype(auto) pass_argument(T& arg) {
+    if constexpr (is_rvalue_reference_v<A>) {
+      return remove_cvref_t<A>(arg);
+    } else if constexpr (is_lvalue_reference_v<A>) {
+      return static_cast<A>(arg);
+    } else {
+      return static_cast<const A&>(arg);
+    }
+  }
+  template <class D, class... As, class... Args>
+  typename D::return_type broadcast(tuple<As...>*, Args&... args) {
+    using R = typename D::return_type;
+    read_guard guard{*this};
+    const vector<subscriber>& subscribers = guard->subscribers;
+    conditional_t<is_void_v<R>, tuple<>, R> result{};
+    auto it = subscribers.begin();
+    while (it != subscribers.end() && it->key() == 0u) {
+      ++it;  // Empty proxies are sorted first and have nothing to notify
+    }
+    while (it != subscribers.end()) {
+      auto dispatcher = static_cast<const typename Traits::meta_type*>(
+          it->target->meta_)->template dispatch_meta<D>::dispatcher;
+      uintptr_t key = it->key();
+      do {
+        proxy<F>& target = *it->target;
+        if constexpr (is_void_v<R>) {
+          dispatcher(target.ptr_, pass_argument<As>(args)...);
+        } else {
+          result = dispatcher(target.ptr_, pass_argument<As>(args)...);
+        }
+      } while (++it != subscribers.end() && it->key() == key);
+    }
+    if constexpr (!is_void_v<R>) {
+      return result;
+    }
+  }
+
+  atomic<snapshot*> current_;
+  atomic<snapshot*> retired_{nullptr};
+  atomic<size_t> epoch_{0u};
+  mutable array<atomic<size_t>, 2u> readers_{};
+  atomic<size_t> next_id_{0u};
+};
+
+class shm_arena {
+ public:
+  explicit shm_arena(size_t capacity) noexcept
+      : used_(0u), capacity_(capacity > sizeof(shm_arena) ?
+            capacity - sizeof(shm_arena) : 0u) {}
+  shm_arena(const shm_arena&) = delete;
+  shm_arena& operator=(const shm_arena&) = delete;
+
+  void* allocate(size_t size, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(this + 1);
+    size_t used = used_.load(memory_order_relaxed);
+    size_t offset;
+    do {
+      offset = ((base + used + alignment - 1u) & ~(alignment - 1u)) - base;
+      if (offset > capacity_ || size > capacity_ - offset) {
+        throw bad_alloc{};
+      }
+    } while (!used_.compare_exchange_weak(used, offset + size,
+        memory_order_relaxed));
+    return reinterpret_cast<void*>(base + offset);
+  }
+  size_t used() const noexcept { return used_.load(memory_order_relaxed); }
+  size_t capacity() const noexcept { return capacity_; }
+
+ private:
+  atomic<size_t> used_;
+  size_t capacity_;
+};
+
+namespace details {
+
+template <class T>
+class offset_ptr {
+ public:
+  explicit offset_ptr(T* target) noexcept : offset_(distance_to(target)) {}
+  offset_ptr(offset_ptr&& rhs) noexcept
+      : offset_(rhs.offset_ == 0 ? 0 : distance_to(rhs.get()))
+      { rhs.offset_ = 0; }
+  offset_ptr(const offset_ptr&) = delete;
+  ~offset_ptr() noexcept {
+    if (offset_ != 0) {
+      get()->~T();
+    }
+  }
+
+  T& operator*() const { return *get(); }
+
+ private:
+  ptrdiff_t distance_to(const T* target) const noexcept {
+    return reinterpret_cast<intptr_t>(target) -
+        reinterpret_cast<intptr_t>(this);
+  }
+  T* get() const noexcept {
+    return reinterpret_cast<T*>(reinterpret_cast<intptr_t>(this) + offset_);
+  }
+
+  ptrdiff_t offset_;
+};
+
+inline constexpr char shm_meta_anchor = 0;
+
+}  // namespace details
+
+template <class F> requires(details::facade_traits<F>::applicable)
+class shm_proxy {
+  using BasicTraits = details::basic_facade_traits<F>;
+  using Traits = details::facade_traits<F>;
+
+ public:
+  shm_proxy() noexcept : meta_offset_(0) {}
+  shm_proxy(const shm_proxy&) = delete;
+  shm_proxy& operator=(const shm_proxy&) = delete;
+  ~shm_proxy() noexcept { reset(); }
+
+  bool has_value() const noexcept { return meta_offset_ != 0; }
+  void reset() noexcept {
+    if constexpr (F::minimum_destructibility > constraint_level::none &&
+        F::minimum_destructibility < constraint_level::trivial) {
+      if (meta_offset_ != 0) {
+        meta()->destroy(ptr_);
+      }
+    }
+    meta_offset_ = 0;
+  }
+  template <class T, class... Args>
+  T& emplace(shm_arena& arena, Args&&... args)
+      requires(is_trivially_copyable_v<T> &&
+          is_constructible_v<T, Args...> &&
+          (proxiable<details::sbo_ptr<T>, F> ||
+              proxiable<details::offset_ptr<T>, F>)) {
+    reset();
+    if constexpr (proxiable<details::sbo_ptr<T>, F>) {
+      auto* ptr = new(ptr_) details::sbo_ptr<T>(forward<Args>(args)...);
+      set_meta(&Traits::template meta<details::sbo_ptr<T>>);
+      return **ptr;
+    } else {
+      T* value = new(arena.allocate(sizeof(T), alignof(T)))
+          T(forward<Args>(args)...);
+      new(ptr_) details::offset_ptr<T>(value);
+      set_meta(&Traits::template meta<details::offset_ptr<T>>);
+      return *value;
+    }
+  }
+  template <class D = typename BasicTraits::default_dispatch, class... Args>
+  decltype(auto) invoke(Args&&... args)
+      requires(BasicTraits::template has_dispatch<D> &&
+          is_convertible_v<tuple<Args...>, typename D::argument_types>) {
+    return meta()->template dispatch_meta<D>::dispatcher(
+        ptr_, forward<Args>(args)...);
+  }
+
+ private:
+  static intptr_t anchor() noexcept
+      { return reinterpret_cast<intptr_t>(&details::shm_meta_anchor); }
+  const typename Traits::meta_type* meta() const noexcept {
+    return reinterpret_cast<const typename Traits::meta_type*>(
+        anchor() + meta_offset_);
+  }
+  void set_meta(const typename Traits::meta_type* meta) noexcept
+      { meta_offset_ = reinterpret_cast<intptr_t>(meta) - anchor(); }
+
+  ptrdiff_t meta_offset_;
+  alignas(F::maximum_alignment) char ptr_[F::maximum_size];
+};
+
 template <class F>
 void swap(proxy<F>& a, proxy<F>& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
 